@@ -85,15 +85,16 @@ int compareSuffix(const string& s, int suffix_pos, const string& query) {
     return -1;
 }
 
-SuffixArray::SuffixArray(const string &s) : s(s)
+// The text and suffix array are taken by value so callers can move them in without a copy.
+SuffixArray::SuffixArray(string s) : s(std::move(s))
 {
     buildSuffixArray();
 }
 
-SuffixArray::SuffixArray(const string &s, const vector<int> &suffix_array) 
-    : s(s), suffix_array(suffix_array)
+SuffixArray::SuffixArray(string s, vector<int> suffix_array) 
+    : suffix_array(std::move(suffix_array)), s(std::move(s))
 {
-    if (suffix_array.size() != s.size()) {
+    if (this->suffix_array.size() != this->s.size()) {
         throw std::invalid_argument("Suffix array size must match string size.");
     }
 }
@@ -9,8 +9,8 @@ public:
     std::vector<int> suffix_array;
     std::string s;
 
-    SuffixArray(const std::string &s);
-    SuffixArray(const std::string &s, const std::vector<int> &suffix_array);
+    SuffixArray(std::string s);
+    SuffixArray(std::string s, std::vector<int> suffix_array);
 
     void printMemorySize() const;
 
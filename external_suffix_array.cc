@@ -0,0 +1,442 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+
+#include "external_suffix_array.hpp"
+
+using std::cout;
+using std::endl;
+
+namespace
+{
+constexpr size_t kMinMemoryBudget = 4 << 20;
+constexpr size_t kMaxIoBufferSize = 16 << 20;
+constexpr size_t kMinMergeBuffer = 64 << 10;
+
+/// A suffix ranked by a pair of names: the names of the suffixes at `pos` and `pos + h`
+/// (initially the two halves of the first 8 bytes of the suffix).
+struct RankTriple
+{
+    uint32_t first;
+    uint32_t second;
+    int pos;
+};
+
+struct PositionName
+{
+    int pos;
+    uint32_t name;
+};
+
+static_assert(sizeof(RankTriple) == 12, "RankTriple must be packed");
+static_assert(sizeof(PositionName) == 8, "PositionName must be packed");
+
+struct ByRankPair
+{
+    bool operator()(const RankTriple &a, const RankTriple &b) const
+    {
+        if (a.first != b.first)
+            return a.first < b.first;
+        return a.second < b.second;
+    }
+};
+
+struct ByPosition
+{
+    bool operator()(const PositionName &a, const PositionName &b) const
+    {
+        return a.pos < b.pos;
+    }
+};
+
+/// A slice of the memory the builder allocates once for the whole build.
+struct Workspace
+{
+    char *data;
+    size_t size;
+
+    template <class Record>
+    Record *records() const
+    {
+        return reinterpret_cast<Record *>(data);
+    }
+
+    template <class Record>
+    size_t capacity() const
+    {
+        return size / sizeof(Record);
+    }
+
+    Workspace slice(size_t index, size_t count) const
+    {
+        size_t part = size / count / 16 * 16;
+        return {data + index * part, part};
+    }
+};
+
+template <class Record>
+class RecordWriter
+{
+public:
+    RecordWriter(const std::string &filename, Workspace buffer)
+        : file(filename, std::ios::binary | std::ios::trunc),
+          buffer(buffer.records<Record>()), capacity(buffer.capacity<Record>())
+    {
+    }
+
+    /// Returns false once a write has failed.
+    bool push(const Record &record)
+    {
+        buffer[count++] = record;
+        if (count == capacity)
+            return flush();
+        return true;
+    }
+
+    bool finish()
+    {
+        bool ok = flush();
+        file.close();
+        return ok;
+    }
+
+private:
+    std::ofstream file;
+    Record *buffer;
+    size_t capacity;
+    size_t count = 0;
+
+    bool flush()
+    {
+        file.write(reinterpret_cast<const char *>(buffer), count * sizeof(Record));
+        count = 0;
+        return file.good();
+    }
+};
+
+template <class Record>
+class RecordReader
+{
+public:
+    RecordReader(const std::string &filename, Workspace buffer, size_t first_record = 0)
+        : file(filename, std::ios::binary),
+          buffer(buffer.records<Record>()), capacity(buffer.capacity<Record>())
+    {
+        file.seekg(first_record * sizeof(Record));
+    }
+
+    bool next(Record &record)
+    {
+        if (cursor == filled && !refill())
+            return false;
+        record = buffer[cursor++];
+        return true;
+    }
+
+private:
+    std::ifstream file;
+    Record *buffer;
+    size_t capacity;
+    size_t cursor = 0;
+    size_t filled = 0;
+
+    bool refill()
+    {
+        if (!file)
+            return false;
+        file.read(reinterpret_cast<char *>(buffer), capacity * sizeof(Record));
+        filled = file.gcount() / sizeof(Record);
+        cursor = 0;
+        return filled > 0;
+    }
+};
+
+/// Sorts records pushed one at a time within `memory`: full buffers are sorted and spilled
+/// as runs, which `finish` k-way merges (in several levels if there are too many runs),
+/// reusing `memory` for the merge buffers and `io` for intermediate merge output.
+template <class Record, class Less>
+class ExternalSorter
+{
+public:
+    ExternalSorter(const std::string &run_prefix, Workspace memory, Workspace io)
+        : run_prefix(run_prefix), memory(memory), io(io),
+          run(memory.records<Record>()), run_capacity(memory.capacity<Record>())
+    {
+    }
+
+    ~ExternalSorter()
+    {
+        for (const auto &name : run_files)
+            std::remove(name.c_str());
+    }
+
+    /// Returns false once spilling a run has failed; nothing is written after that.
+    bool push(const Record &record)
+    {
+        if (!ok)
+            return false;
+        run[run_size++] = record;
+        ++pushed;
+        if (run_size == run_capacity)
+            spill();
+        return ok;
+    }
+
+    /// Calls `visit` on every record in sorted order, stopping early if it returns false.
+    template <class Visitor>
+    bool finish(Visitor &&visit)
+    {
+        size_t visited = 0;
+        auto counted_visit = [&](const Record &record)
+        {
+            ++visited;
+            return visit(record);
+        };
+
+        if (ok && run_files.empty())
+        {
+            std::sort(run, run + run_size, Less());
+            for (size_t i = 0; ok && i < run_size; ++i)
+                ok = counted_visit(run[i]);
+            run_size = 0;
+            return ok && visited == pushed;
+        }
+
+        if (ok && run_size > 0)
+            spill();
+
+        size_t max_fan_in = std::max<size_t>(2, memory.size / kMinMergeBuffer);
+        while (ok && run_files.size() > max_fan_in)
+        {
+            std::vector<std::string> merged;
+            for (size_t i = 0; ok && i < run_files.size(); i += max_fan_in)
+            {
+                std::vector<std::string> group(run_files.begin() + i,
+                                               run_files.begin() + std::min(i + max_fan_in, run_files.size()));
+                std::string name = nextRunName();
+                RecordWriter<Record> writer(name, io);
+                merged.push_back(name);
+                ok = mergeRuns(group, [&](const Record &record)
+                               { return writer.push(record); });
+                ok = writer.finish() && ok;
+            }
+            for (const auto &name : run_files)
+                std::remove(name.c_str());
+            run_files = merged;
+        }
+
+        ok = ok && mergeRuns(run_files, counted_visit);
+        for (const auto &name : run_files)
+            std::remove(name.c_str());
+        run_files.clear();
+        return ok && visited == pushed;
+    }
+
+private:
+    std::string run_prefix;
+    Workspace memory;
+    Workspace io;
+    Record *run;
+    size_t run_capacity;
+    size_t run_size = 0;
+    size_t pushed = 0;
+    int run_count = 0;
+    bool ok = true;
+    std::vector<std::string> run_files;
+
+    std::string nextRunName()
+    {
+        return run_prefix + "." + std::to_string(run_count++) + ".tmp";
+    }
+
+    void spill()
+    {
+        std::sort(run, run + run_size, Less());
+        std::string name = nextRunName();
+        run_files.push_back(name);
+        std::ofstream file(name, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(run), run_size * sizeof(Record));
+        if (!file)
+        {
+            std::cerr << "Error: Cannot write run file " << name << std::endl;
+            ok = false;
+        }
+        run_size = 0;
+    }
+
+    template <class Visitor>
+    bool mergeRuns(const std::vector<std::string> &files, Visitor &&visit) const
+    {
+        std::vector<RecordReader<Record>> readers;
+        readers.reserve(files.size());
+        for (size_t i = 0; i < files.size(); ++i)
+            readers.emplace_back(files[i], memory.slice(i, files.size()));
+
+        using Head = std::pair<Record, size_t>;
+        auto greater = [](const Head &a, const Head &b)
+        { return Less()(b.first, a.first); };
+        std::priority_queue<Head, std::vector<Head>, decltype(greater)> heap(greater);
+        for (size_t i = 0; i < readers.size(); ++i)
+        {
+            Record record;
+            if (readers[i].next(record))
+                heap.push({record, i});
+        }
+        while (!heap.empty())
+        {
+            Head head = heap.top();
+            heap.pop();
+            if (!visit(head.first))
+                return false;
+            if (readers[head.second].next(head.first))
+                heap.push(head);
+        }
+        return true;
+    }
+};
+
+using TripleSorter = ExternalSorter<RankTriple, ByRankPair>;
+using PositionSorter = ExternalSorter<PositionName, ByPosition>;
+
+/// Streams the text once, dropping the bytes `normalize_to_ascii` drops, and pushes every
+/// suffix ranked by its first 8 bytes (zero padded past the end of the text).
+/// Sets `n` to the normalized text length.
+bool pushInitialRanks(const std::string &filename, Workspace chunk, TripleSorter &sorter, long long &n)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "Error: Cannot open file " << filename << std::endl;
+        return false;
+    }
+
+    auto push = [&](long long pos, uint64_t window)
+    {
+        return sorter.push({(uint32_t)(window >> 32), (uint32_t)window, (int)pos});
+    };
+    uint64_t window = 0;
+    n = 0;
+    while (file)
+    {
+        file.read(chunk.data, chunk.size);
+        std::streamsize got = file.gcount();
+        for (std::streamsize i = 0; i < got; ++i)
+        {
+            unsigned char c = chunk.data[i];
+            if (c < 32 || c > 126)
+                continue;
+            window = (window << 8) | c;
+            if (++n >= 8 && !push(n - 8, window))
+                return false;
+        }
+        if (n > INT_MAX)
+        {
+            std::cerr << "Error: " << filename << " is too large for 32-bit suffix array entries." << std::endl;
+            return false;
+        }
+    }
+    for (int pad = 1; pad < 8; ++pad)
+    {
+        window <<= 8;
+        if (n - 8 + pad >= 0 && !push(n - 8 + pad, window))
+            return false;
+    }
+    return !file.bad();
+}
+} // namespace
+
+ExternalSuffixArrayBuilder::ExternalSuffixArrayBuilder(const std::string &text_filename, size_t memory_budget)
+    : text_filename(text_filename), memory_budget(memory_budget)
+{
+    if (memory_budget < kMinMemoryBudget)
+    {
+        throw std::invalid_argument("Memory budget must be at least 4MB.");
+    }
+    // Two sorters are live at once (one merging, one filling), next to three streaming buffers.
+    io_buffer_size = std::min(memory_budget / 32, kMaxIoBufferSize) / 16 * 16;
+    sorter_budget = (memory_budget - 3 * io_buffer_size) / 2 / 16 * 16;
+}
+
+/// Each round merges the suffixes sorted by their rank pairs, names equal pairs, and writes
+/// the order to a temporary file. Once every name is unique that order is the suffix array and
+/// is renamed to `output_filename`; otherwise the names are re-sorted into text order and
+/// paired with the names `h` further on.
+/// All buffers are carved out of one allocation made up front, so memory stays within the
+/// budget however many rounds the text needs.
+bool ExternalSuffixArrayBuilder::build(const std::string &output_filename)
+{
+    size_t total_size = 2 * sorter_budget + 3 * io_buffer_size;
+    std::unique_ptr<uint64_t[]> memory(new uint64_t[total_size / sizeof(uint64_t)]);
+    char *base = reinterpret_cast<char *>(memory.get());
+    Workspace triple_memory = {base, sorter_budget};
+    Workspace position_memory = {base + sorter_budget, sorter_budget};
+    Workspace io[3];
+    for (int i = 0; i < 3; ++i)
+        io[i] = {base + 2 * sorter_budget + i * io_buffer_size, io_buffer_size};
+
+    std::string order_filename = output_filename + ".order.tmp";
+    std::string names_filename = output_filename + ".names.tmp";
+
+    auto triples = std::make_unique<TripleSorter>(output_filename + ".triples0", triple_memory, io[1]);
+    long long n = 0;
+    bool ok = pushInitialRanks(text_filename, io[0], *triples, n);
+
+    long long h = 8;
+    for (int round = 0; ok; ++round)
+    {
+        PositionSorter by_position(output_filename + ".positions" + std::to_string(round), position_memory, io[2]);
+        RecordWriter<int> order_writer(order_filename, io[0]);
+        uint32_t names = 0;
+        RankTriple prev = {0, 0, 0};
+        ok = triples->finish([&](const RankTriple &t)
+                             {
+            if (names == 0 || t.first != prev.first || t.second != prev.second)
+                ++names;
+            prev = t;
+            return by_position.push({t.pos, names}) && order_writer.push(t.pos); });
+        ok = order_writer.finish() && ok;
+        if (ok && names == n)
+        {
+            ok = std::rename(order_filename.c_str(), output_filename.c_str()) == 0;
+            if (ok)
+                cout << "All ranks are unique, no need to sort further." << " " << h << endl;
+            break;
+        }
+        if (!ok)
+            break;
+
+        RecordWriter<uint32_t> names_writer(names_filename, io[0]);
+        ok = by_position.finish([&](const PositionName &p)
+                                { return names_writer.push(p.name); });
+        ok = names_writer.finish() && ok;
+
+        triples = std::make_unique<TripleSorter>(output_filename + ".triples" + std::to_string(round + 1), triple_memory, io[1]);
+        RecordReader<uint32_t> current(names_filename, io[0]);
+        RecordReader<uint32_t> ahead(names_filename, io[2], std::min(h, n));
+        for (long long i = 0; ok && i < n; ++i)
+        {
+            uint32_t first = 0, second = 0;
+            ok = current.next(first) && (i + h >= n || ahead.next(second)) &&
+                 triples->push({first, second, (int)i});
+        }
+        std::remove(names_filename.c_str());
+        h *= 2;
+    }
+
+    if (!ok)
+    {
+        std::remove(order_filename.c_str());
+        std::remove(names_filename.c_str());
+        std::cerr << "Error: Failed to build suffix array into " << output_filename << std::endl;
+        return false;
+    }
+    return true;
+}
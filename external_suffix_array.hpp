@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/// Builds a suffix array for a text file without holding the whole array in memory.
+/// Uses prefix doubling like `SuffixArray`, but every rank sort is an external merge sort
+/// bounded by `memory_budget`, so each round reads and writes a fixed number of bytes per
+/// suffix and never touches the text at random.
+/// The text is normalized like `normalize_to_ascii` while it is read, so the result matches
+/// the text `main` loads from the same file.
+/// The output is the suffix array as raw native-endian 32-bit ints (see `readBinarySuffixArray`).
+class ExternalSuffixArrayBuilder
+{
+public:
+    ExternalSuffixArrayBuilder(const std::string &text_filename, size_t memory_budget);
+
+    bool build(const std::string &output_filename);
+
+private:
+    std::string text_filename;
+    size_t memory_budget;
+    size_t io_buffer_size;
+    size_t sorter_budget;
+};
@@ -7,6 +7,7 @@
 #include <random>
 
 #include "build_suffix_array.hpp"
+#include "external_suffix_array.hpp"
 #include "psi_suffix_array.hpp"
 #include "utils.hpp"
 
@@ -14,14 +15,28 @@ int main()
 {
     std::string filename = "100MB_random_chars.txt";
     // std::string filename = "wiki_100MB.txt";
+
+    // set to build the suffix array of `filename` on disk under a memory budget and exit,
+    // without loading a text that may not fit in memory; the builder normalizes it like below
+    bool build_external = false;
+    if (build_external)
+    {
+        ExternalSuffixArrayBuilder builder(filename, size_t(1) << 30);
+        return builder.build("100MB_random_chars_sa.bin") ? 0 : 1;
+    }
+
     std::string text;
-    if (!readFile(filename, text))
+    auto load_start = std::chrono::high_resolution_clock::now();
+    if (!loadText(filename, text))
     {
         std::cerr << "Error: Could not read file " << filename << std::endl;
         return 1;
     }
-    text = normalize_to_ascii(text);
+    normalize_to_ascii_inplace(text);
     text += "\0x3";
+    std::cout << "Text loaded in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - load_start).count()
+              << " ms." << std::endl;
 
     // std::cout << text.size() << " characters read from file." << std::endl;
     // std::random_device rnd;
@@ -35,6 +50,7 @@ int main()
 
     std::vector<int> suffix_array;
     suffix_array.reserve(text.size());
+    // if (!readBinarySuffixArray("100MB_random_chars_sa.bin", suffix_array))
     if (!readSuffixArray("100MB_random_chars_sa.txt", suffix_array))
     {
         std::cerr << "Error: Could not read suffix array file." << std::endl;
@@ -45,9 +61,9 @@ int main()
         std::cout << "Suffix array read successfully." << std::endl;
     }
 
-    // SuffixArray sa(text);
-    SuffixArray sa(text, suffix_array);
-    // checkSuffixArray(text, sa.suffix_array);
+    // SuffixArray sa(std::move(text));
+    SuffixArray sa(std::move(text), std::move(suffix_array));
+    // checkSuffixArray(sa.s, sa.suffix_array);
 
     // dump suffix array to file
     // std::ofstream sa_file("100MB_random_chars_sa.txt");
@@ -77,7 +93,7 @@ int main()
                 int sa_result = sa.findTextIndexByQuery(query);
                 if (i >= 10)
                     ave_time += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
-                if (sa_result == -1 || text.substr(sa_result, query.size()) != query)
+                if (sa_result == -1 || sa.s.substr(sa_result, query.size()) != query)
                 {
                     std::cerr << "Error: SuffixArray index mismatch for query '" << query << "'." << std::endl;
                 }
@@ -99,7 +115,7 @@ int main()
         {
             double find_ave_time = 0.0;
             double sa_ave_time = 0.0;
-            PsiSuffixArray psi(text, sa.suffix_array, compress_step, sample_step);
+            PsiSuffixArray psi(sa.s, sa.suffix_array, compress_step, sample_step);
             for (int i = 0; i < 20; ++i)
             {
                 std::string query = queries[i + epoch * 20];
@@ -111,7 +127,7 @@ int main()
                 int sa_result = psi.getTextIndexFromPsiIndex(psi_index);
                 if (i >= 10)
                     sa_ave_time += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
-                if (sa_result == -1 || text.substr(sa_result, query.size()) != query)
+                if (sa_result == -1 || sa.s.substr(sa_result, query.size()) != query)
                 {
                     std::cerr << "Error: SuffixArray index mismatch for query '" << query << "'." << std::endl;
                 }
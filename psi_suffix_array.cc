@@ -1,6 +1,7 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <algorithm>
 #include <array>
 
@@ -9,7 +10,7 @@
 using std::cout;
 using std::endl;
 
-PsiSuffixArray::PsiSuffixArray(const std::string &s, const std::vector<int> &suffix_array, int compress_step, int sample_step)
+PsiSuffixArray::PsiSuffixArray(std::string_view s, const std::vector<int> &suffix_array, int compress_step, int sample_step)
     : compress_step(compress_step), sample_step(sample_step)
 {
     sampleSuffixArray(suffix_array);
@@ -18,7 +19,7 @@ PsiSuffixArray::PsiSuffixArray(const std::string &s, const std::vector<int> &suf
 
 /// Converts a suffix array into a ψ-array.
 /// Also records character-region ranges and sampled characters for fast lookup.
-void PsiSuffixArray::convertToPsi(const std::string &s, const std::vector<int> &sa)
+void PsiSuffixArray::convertToPsi(std::string_view s, const std::vector<int> &sa)
 {
     int n = s.size();
     psi_size = n;
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
 
 #include "compresser.hpp"
 
@@ -14,7 +15,7 @@ struct Region
 class PsiSuffixArray
 {
 public:
-    PsiSuffixArray(const std::string& s, const std::vector<int> &suffix_array, int compress_step, int sample_step);
+    PsiSuffixArray(std::string_view s, const std::vector<int> &suffix_array, int compress_step, int sample_step);
 
     void printMemorySize() const;
 
@@ -31,7 +32,7 @@ private:
     int psi_size;
     int sample_char_step = 128;
 
-    void convertToPsi(const std::string &s, const std::vector<int> &suffix_array);
+    void convertToPsi(std::string_view s, const std::vector<int> &suffix_array);
     void compressPsi(const std::vector<int> &psi);
     void sampleSuffixArray(const std::vector<int> &suffix_array);
     int getPsiValue(unsigned char c, int index) const;
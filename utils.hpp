@@ -4,6 +4,16 @@
 #include <string>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 bool readFile(const std::string& filename, std::string& content) {
     std::ifstream file(filename);
@@ -18,6 +28,45 @@ bool readFile(const std::string& filename, std::string& content) {
     return true;
 }
 
+// Reads the whole file straight into `content` with large read(2) calls.
+// Regular files are sized up front so the text is neither copied nor reallocated;
+// pipes, procfs and other streams are read in growing blocks until EOF.
+bool loadText(const std::string& filename, std::string& content) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error: Cannot open file " << filename << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        std::cerr << "Error: Cannot stat file " << filename << std::endl;
+        close(fd);
+        return false;
+    }
+
+    bool regular = S_ISREG(st.st_mode) && st.st_size > 0; // procfs files report size 0
+    content.resize(regular ? st.st_size : 1 << 20);
+    size_t done = 0;
+    while (!regular || done < content.size()) {
+        if (done == content.size())
+            content.resize(content.size() * 2);
+        ssize_t got = read(fd, content.data() + done, std::min<size_t>(content.size() - done, 1 << 30));
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got < 0) {
+            std::cerr << "Error: Failed to read file " << filename << std::endl;
+            close(fd);
+            return false;
+        }
+        if (got == 0)
+            break;
+        done += got;
+    }
+    content.resize(done);
+    close(fd);
+    return true;
+}
+
 bool readSuffixArray(const std::string& filename, std::vector<int>& suffix_array) {
     std::ifstream file(filename);
     if (!file) {
@@ -42,6 +91,23 @@ bool readSuffixArray(const std::string& filename, std::vector<int>& suffix_array
     return true;
 }
 
+bool readBinarySuffixArray(const std::string& filename, std::vector<int>& suffix_array) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file) {
+        std::cerr << "Error: Cannot open file " << filename << std::endl;
+        return false;
+    }
+
+    std::streamsize size = file.tellg();
+    if (size % sizeof(int) != 0) {
+        std::cerr << "Error: Invalid binary suffix array size " << size << std::endl;
+        return false;
+    }
+    suffix_array.resize(size / sizeof(int));
+    file.seekg(0);
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(suffix_array.data()), size));
+}
+
 std::string normalize_to_ascii(const std::string& input) {
     std::string result;
     for (unsigned char c : input) {
@@ -51,6 +117,40 @@ std::string normalize_to_ascii(const std::string& input) {
     return result;
 }
 
+// Same filter as normalize_to_ascii, but compacts `text` in place.
+// Blocks of 16 printable bytes are moved at once with SSE2.
+void normalize_to_ascii_inplace(std::string& text) {
+    char* data = text.data();
+    size_t n = text.size();
+    size_t r = 0, w = 0;
+#ifdef __SSE2__
+    const __m128i lower = _mm_set1_epi8(31);
+    const __m128i upper = _mm_set1_epi8(127);
+    for (; r + 16 <= n; r += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + r));
+        // signed compares, so bytes >= 128 fail the lower bound
+        __m128i ok = _mm_and_si128(_mm_cmpgt_epi8(v, lower), _mm_cmplt_epi8(v, upper));
+        int mask = _mm_movemask_epi8(ok);
+        if (mask == 0xFFFF) {
+            if (w != r)
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(data + w), v);
+            w += 16;
+            continue;
+        }
+        for (int i = 0; i < 16; ++i) {
+            if (mask & (1 << i))
+                data[w++] = data[r + i];
+        }
+    }
+#endif
+    for (; r < n; ++r) {
+        unsigned char c = data[r];
+        if (c >= 32 && c <= 126)
+            data[w++] = c;
+    }
+    text.resize(w);
+}
+
 bool checkSuffixArray(const std::string& s, const std::vector<int>& sa) {
     for (int i = 1; i < sa.size(); ++i) {
         if (s.substr(sa[i - 1]) > s.substr(sa[i])) {